@@ -35,22 +35,6 @@
 
 namespace mongo {
 
-namespace {
-
-static constexpr auto kReadConcernLevelsDisallowedAsDefault = {
-    repl::ReadConcernLevel::kSnapshotReadConcern, repl::ReadConcernLevel::kLinearizableReadConcern};
-
-}
-
-bool ReadWriteConcernDefaults::isSuitableReadConcernLevel(repl::ReadConcernLevel level) {
-    for (auto bannedLevel : kReadConcernLevelsDisallowedAsDefault) {
-        if (level == bannedLevel) {
-            return false;
-        }
-    }
-    return true;
-}
-
 void ReadWriteConcernDefaults::checkSuitabilityAsDefault(const ReadConcern& rc) {
     uassert(ErrorCodes::BadValue,
             str::stream() << "level: '" << repl::readConcernLevels::toString(rc.getLevel())
@@ -77,7 +61,7 @@ void ReadWriteConcernDefaults::checkSuitabilityAsDefault(const WriteConcern& wc)
 }
 
 void ReadWriteConcernDefaults::_setDefault(RWConcernDefault&& rwc) {
-    _defaults.revalidate(Type::kReadWriteConcernEntry, std::move(rwc));
+    _defaults.revalidate(std::move(rwc));
 }
 
 RWConcernDefault ReadWriteConcernDefaults::setConcerns(OperationContext* opCtx,
@@ -109,26 +93,23 @@ RWConcernDefault ReadWriteConcernDefaults::setConcerns(OperationContext* opCtx,
     if (!wc && current) {
         rwc.setDefaultWriteConcern(current->getDefaultWriteConcern());
     }
+
+    // Return the value just written rather than re-reading it from the cache, which would cost a
+    // second acquire and another full copy of the document.
+    RWConcernDefault result = rwc;
     _setDefault(std::move(rwc));
-    return *_getDefault(opCtx);
+    return result;
 }
 
-void ReadWriteConcernDefaults::invalidate() {
-    _defaults.invalidate(Type::kReadWriteConcernEntry);
+void ReadWriteConcernDefaults::invalidate() noexcept {
+    _defaults.invalidate();
 }
 
 boost::optional<RWConcernDefault> ReadWriteConcernDefaults::_getDefault(OperationContext* opCtx) {
-    auto defaultsHandle = _defaults.acquire(opCtx, Type::kReadWriteConcernEntry);
-    if (defaultsHandle) {
-        auto& defaultsValue = **defaultsHandle;
-        // Since CWRWC is ok with continuing to use a value well after it has been invalidated
-        // (since RWC defaults apply for the lifetime of the op/cursor), we don't need to check
-        // defaultsValue.isValid() here, and we don't need to return the Handle, since callers don't
-        // need to check defaultsValue.isValid() later, either.  Just dereference it to get the
-        // underlying contents.
-        return *defaultsValue;
-    }
-    return boost::none;
+    // Since CWRWC is ok with continuing to use a value well after it has been invalidated (since
+    // RWC defaults apply for the lifetime of the op/cursor), there is no need to revalidate the
+    // returned snapshot against concurrent invalidations.  Just copy out its contents.
+    return *_defaults.acquire(opCtx);
 }
 
 RWConcernDefault ReadWriteConcernDefaults::getDefault(OperationContext* opCtx) {
@@ -137,14 +118,18 @@ RWConcernDefault ReadWriteConcernDefaults::getDefault(OperationContext* opCtx) {
 
 boost::optional<ReadWriteConcernDefaults::ReadConcern>
 ReadWriteConcernDefaults::getDefaultReadConcern(OperationContext* opCtx) {
-    auto current = getDefault(opCtx);
-    return current.getDefaultReadConcern();
+    // Hold the snapshot handle (which keeps the underlying document alive) and copy out only the
+    // requested concern, rather than copying the whole defaults document.
+    auto handle = _defaults.acquire(opCtx);
+    const auto& current = *handle;
+    return current ? current->getDefaultReadConcern() : boost::none;
 }
 
 boost::optional<ReadWriteConcernDefaults::WriteConcern>
 ReadWriteConcernDefaults::getDefaultWriteConcern(OperationContext* opCtx) {
-    auto current = getDefault(opCtx);
-    return current.getDefaultWriteConcern();
+    auto handle = _defaults.acquire(opCtx);
+    const auto& current = *handle;
+    return current ? current->getDefaultWriteConcern() : boost::none;
 }
 
 namespace {
@@ -163,19 +148,51 @@ ReadWriteConcernDefaults& ReadWriteConcernDefaults::get(ServiceContext& service)
 }
 
 void ReadWriteConcernDefaults::create(ServiceContext* service, LookupFn lookupFn) {
-    getReadWriteConcernDefaults(service) = std::make_unique<ReadWriteConcernDefaults>(lookupFn);
+    getReadWriteConcernDefaults(service) =
+        std::make_unique<ReadWriteConcernDefaults>(std::move(lookupFn));
 }
 
-ReadWriteConcernDefaults::ReadWriteConcernDefaults(LookupFn lookupFn) : _defaults(lookupFn) {}
+ReadWriteConcernDefaults::ReadWriteConcernDefaults(LookupFn lookupFn)
+    : _defaults(std::move(lookupFn)) {}
+
+ReadWriteConcernDefaults::Cache::Cache(LookupFn lookupFn) : _lookupFn(std::move(lookupFn)) {}
 
-ReadWriteConcernDefaults::Cache::Cache(LookupFn lookupFn)
-    : DistCache(1, _mutex), _lookupFn(lookupFn) {}
+ReadWriteConcernDefaults::Cache::ValueHandle ReadWriteConcernDefaults::Cache::acquire(
+    OperationContext* opCtx) {
+    if (auto value = std::atomic_load(&_value)) {
+        return value;
+    }
+
+    // The slot is empty, so perform a lookup.  The mutex serializes concurrent lookups (so the
+    // lookup function isn't stampeded) and is also taken by invalidate() and revalidate(), so a
+    // concurrent setConcerns can't be clobbered by a lookup that started before it; readers that
+    // find the slot populated never reach here.
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (auto value = std::atomic_load(&_value)) {
+        // Another thread repopulated the slot while this one was waiting on the mutex.
+        return value;
+    }
 
-boost::optional<RWConcernDefault> ReadWriteConcernDefaults::Cache::lookup(
-    OperationContext* opCtx, const ReadWriteConcernDefaults::Type& key) {
-    invariant(key == Type::kReadWriteConcernEntry);
     // TODO: failpoint to uassert a custom Status
-    return _lookupFn(opCtx);
+    auto value = std::make_shared<const boost::optional<RWConcernDefault>>(_lookupFn(opCtx));
+    std::atomic_store(&_value, value);
+    return value;
+}
+
+void ReadWriteConcernDefaults::Cache::invalidate() noexcept {
+    // Taking the mutex waits out any in-flight lookup, so it can't republish a pre-invalidation
+    // value after this store.  Writes are rare, so this doesn't affect the lock-free read path.
+    stdx::lock_guard<Latch> lk(_mutex);
+    std::atomic_store(&_value, ValueHandle());
+}
+
+void ReadWriteConcernDefaults::Cache::revalidate(RWConcernDefault rwc) {
+    // As in invalidate(), the mutex keeps a lookup that started before this set from overwriting
+    // the just-set value with its stale result.
+    stdx::lock_guard<Latch> lk(_mutex);
+    std::atomic_store(&_value,
+                      ValueHandle(std::make_shared<const boost::optional<RWConcernDefault>>(
+                          std::move(rwc))));
 }
 
 }  // namespace mongo
@@ -30,8 +30,10 @@
 #pragma once
 
 #include <map>
+#include <memory>
+
+#include <boost/optional.hpp>
 
-#include "mongo/db/dist_cache.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/rw_concern_default_gen.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/write_concern_options.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/functional.h"
 
 namespace mongo {
 
@@ -53,7 +56,9 @@ public:
     using ReadConcern = repl::ReadConcernArgs;
     using WriteConcern = WriteConcernOptions;
 
-    using LookupFn = std::function<boost::optional<RWConcernDefault>(OperationContext*)>;
+    // unique_function rather than std::function, so the lookup callable is stored inline (no
+    // shared-state heap allocation) and dispatched without std::function's copyability machinery.
+    using LookupFn = unique_function<boost::optional<RWConcernDefault>(OperationContext*)>;
 
     static constexpr StringData readConcernFieldName = ReadConcern::kReadConcernFieldName;
     static constexpr StringData writeConcernFieldName = WriteConcern::kWriteConcernField;
@@ -70,7 +75,14 @@ public:
      * Returns true if the RC level is permissible to use as a default, and false if it cannot be a
      * RC default.
      */
-    static bool isSuitableReadConcernLevel(repl::ReadConcernLevel level);
+    static constexpr bool isSuitableReadConcernLevel(repl::ReadConcernLevel level) noexcept {
+        // Bitmask over ReadConcernLevel values of the levels disallowed as a default, so the check
+        // is a single branchless shift-and-mask that callers can inline.
+        constexpr auto kDisallowedMask =
+            (1u << static_cast<unsigned>(repl::ReadConcernLevel::kSnapshotReadConcern)) |
+            (1u << static_cast<unsigned>(repl::ReadConcernLevel::kLinearizableReadConcern));
+        return ((kDisallowedMask >> static_cast<unsigned>(level)) & 1u) == 0;
+    }
 
     /**
      * Checks if the given RWC is suitable to use as a default, and uasserts if not.
@@ -95,32 +107,56 @@ public:
      * replaced by the refreshed values.  This is to avoid stalling CRUD ops (and other ops that
      * need RC/WC) during refresh.
      */
-    void invalidate();
+    void invalidate() noexcept;
 
-    RWConcernDefault getDefault(OperationContext* opCtx);
-    boost::optional<ReadConcern> getDefaultReadConcern(OperationContext* opCtx);
-    boost::optional<WriteConcern> getDefaultWriteConcern(OperationContext* opCtx);
+    [[nodiscard]] RWConcernDefault getDefault(OperationContext* opCtx);
+    [[nodiscard]] boost::optional<ReadConcern> getDefaultReadConcern(OperationContext* opCtx);
+    [[nodiscard]] boost::optional<WriteConcern> getDefaultWriteConcern(OperationContext* opCtx);
 
 private:
-    enum class Type { kReadWriteConcernEntry };
-
     void _setDefault(RWConcernDefault&& rwc);
     boost::optional<RWConcernDefault> _getDefault(OperationContext* opCtx);
 
-    class Cache : public DistCache<Type, RWConcernDefault> {
+    /**
+     * Single-slot cache of the cluster-wide defaults document.  The current value is published as
+     * an immutable snapshot read with one atomic load, so the per-operation read path never takes
+     * a mutex; the mutex serializes lookups while the slot is empty and the (rare) writes, so a
+     * stale lookup can never overwrite a newer set.  Readers concurrent with an invalidation may
+     * keep using the previous value, which matches the semantics documented on invalidate().
+     */
+    class Cache {
         Cache(const Cache&) = delete;
         Cache& operator=(const Cache&) = delete;
 
     public:
-        Cache(LookupFn lookupFn);
-        virtual ~Cache() = default;
+        using ValueHandle = std::shared_ptr<const boost::optional<RWConcernDefault>>;
 
-    private:
-        boost::optional<RWConcernDefault> lookup(OperationContext* opCtx, const Type& key) override;
+        explicit Cache(LookupFn lookupFn);
 
-        // For exclusive use by DistCache only.
+        /**
+         * Returns the cached defaults, performing a lookup first if the slot is empty.  The
+         * returned handle is never null; the pointed-to optional is empty if the defaults document
+         * is known not to exist.
+         */
+        ValueHandle acquire(OperationContext* opCtx);
+
+        /**
+         * Empties the slot, causing the next acquire() to perform a fresh lookup.
+         */
+        void invalidate() noexcept;
+
+        /**
+         * Immediately replaces the slot's contents with the given value.
+         */
+        void revalidate(RWConcernDefault rwc);
+
+    private:
+        // Serializes lookups while the slot is empty, and writes with in-flight lookups.
         Mutex _mutex = MONGO_MAKE_LATCH("ReadWriteConcernDefaults::Cache");
 
+        // Accessed only via std::atomic_load/std::atomic_store.
+        ValueHandle _value;
+
         LookupFn _lookupFn;
     };
 
@@ -0,0 +1,146 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/logical_clock.h"
+#include "mongo/db/read_write_concern_defaults.h"
+#include "mongo/db/read_write_concern_defaults_cache_lookup_mock.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
+
+namespace mongo {
+namespace {
+
+class ReadWriteConcernDefaultsTest : public ServiceContextTest {
+protected:
+    ReadWriteConcernDefaultsTest() {
+        LogicalClock::set(getServiceContext(), std::make_unique<LogicalClock>(getServiceContext()));
+    }
+
+    static RWConcernDefault makeDefaultsWithEpoch(Timestamp epoch) {
+        RWConcernDefault rwcd;
+        rwcd.setEpoch(epoch);
+        return rwcd;
+    }
+
+    ReadWriteConcernDefaultsLookupMock _lookupMock;
+
+    long long _numLookups{0};
+
+    ReadWriteConcernDefaults _rwcd{[this](OperationContext* opCtx) {
+        ++_numLookups;
+        return _lookupMock.lookup(opCtx);
+    }};
+
+    ServiceContext::UniqueOperationContext _opCtxHolder{makeOperationContext()};
+    OperationContext* const _opCtx{_opCtxHolder.get()};
+};
+
+TEST_F(ReadWriteConcernDefaultsTest, TestAcquireCachesLookedUpValue) {
+    _lookupMock.setLookupCallReturnValue(makeDefaultsWithEpoch(Timestamp(1, 2)));
+
+    ASSERT_EQ(Timestamp(1, 2), *_rwcd.getDefault(_opCtx).getEpoch());
+    ASSERT_EQ(1, _numLookups);
+
+    // A second read must be served from the cache without consulting the lookup function.
+    ASSERT_EQ(Timestamp(1, 2), *_rwcd.getDefault(_opCtx).getEpoch());
+    ASSERT_EQ(1, _numLookups);
+}
+
+TEST_F(ReadWriteConcernDefaultsTest, TestInvalidateForcesRelookup) {
+    _lookupMock.setLookupCallReturnValue(makeDefaultsWithEpoch(Timestamp(1, 2)));
+    ASSERT_EQ(Timestamp(1, 2), *_rwcd.getDefault(_opCtx).getEpoch());
+    ASSERT_EQ(1, _numLookups);
+
+    // Changing the persisted value alone does not affect what the cache returns.
+    _lookupMock.setLookupCallReturnValue(makeDefaultsWithEpoch(Timestamp(3, 4)));
+    ASSERT_EQ(Timestamp(1, 2), *_rwcd.getDefault(_opCtx).getEpoch());
+    ASSERT_EQ(1, _numLookups);
+
+    // Invalidating the cache forces the next read to look the value up again.
+    _rwcd.invalidate();
+    ASSERT_EQ(Timestamp(3, 4), *_rwcd.getDefault(_opCtx).getEpoch());
+    ASSERT_EQ(2, _numLookups);
+}
+
+TEST_F(ReadWriteConcernDefaultsTest, TestSetConcernsIsNotClobberedByInFlightLookup) {
+    // Reproduces the interleaving where a lookup is already in flight when an administrator sets
+    // new defaults: the (stale) lookup result must not overwrite the just-set value.
+    AtomicWord<long long> numLookups{0};
+    Notification<void> lookupStarted;
+    Notification<void> lookupMayComplete;
+
+    ReadWriteConcernDefaults rwcd([&](OperationContext*) -> boost::optional<RWConcernDefault> {
+        if (numLookups.fetchAndAdd(1) == 0) {
+            lookupStarted.set();
+            lookupMayComplete.get();
+        }
+        // Stale result: no defaults had been persisted when the lookup began.
+        return boost::none;
+    });
+
+    stdx::thread reader([&] {
+        ThreadClient tc("RWCDefaultsReader", getServiceContext());
+        auto opCtx = tc->makeOperationContext();
+
+        // The reader began before the set, so it may see the pre-set state.
+        ASSERT(!rwcd.getDefaultWriteConcern(opCtx.get()));
+    });
+
+    lookupStarted.get();
+
+    stdx::thread setter([&] {
+        ThreadClient tc("RWCDefaultsSetter", getServiceContext());
+        auto opCtx = tc->makeOperationContext();
+
+        WriteConcernOptions wc;
+        wc.wNumNodes = 4;
+        rwcd.setConcerns(opCtx.get(), boost::none, wc);
+    });
+
+    // Let the in-flight lookup publish its stale result while the setter is running.
+    lookupMayComplete.set();
+    reader.join();
+    setter.join();
+
+    // The set value must win over the stale lookup result, and must be served from the cache
+    // without another lookup.
+    auto wc = rwcd.getDefaultWriteConcern(_opCtx);
+    ASSERT(wc);
+    ASSERT_EQ(4, wc->wNumNodes);
+    ASSERT_EQ(1, numLookups.load());
+}
+
+}  // namespace
+}  // namespace mongo
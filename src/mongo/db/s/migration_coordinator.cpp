@@ -35,6 +35,8 @@
 
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/range_deletion_task_gen.h"
+#include "mongo/s/client/shard.h"
+#include "mongo/s/grid.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -47,55 +49,90 @@ MigrationCoordinator::MigrationCoordinator(OperationContext* opCtx,
                                            NamespaceString collectionNamespace,
                                            UUID collectionUuid,
                                            ChunkRange range)
-    : _migrationInfo(migrationId,
-                     std::move(collectionNamespace),
-                     collectionUuid,
-                     std::move(donorShard),
-                     std::move(recipientShard),
-                     std::move(range)) {}
+    : _migrationId(migrationId),
+      _nss(std::move(collectionNamespace)),
+      _collectionUuid(collectionUuid),
+      _donorShardId(std::move(donorShard)),
+      _recipientShardId(std::move(recipientShard)),
+      _range(std::move(range)) {}
 
 MigrationCoordinator::~MigrationCoordinator() = default;
 
 void MigrationCoordinator::startMigration(OperationContext* opCtx, bool waitForDelete) {
-    migrationutil::persistMigrationCoordinatorLocally(opCtx, _migrationInfo);
-
-    RangeDeletionTask donorDeletionTask(_migrationInfo.getId(),
-                                        _migrationInfo.getNss(),
-                                        _migrationInfo.getCollectionUuid(),
-                                        _migrationInfo.getDonorShardId(),
-                                        _migrationInfo.getRange(),
+    RangeDeletionTask donorDeletionTask(_migrationId,
+                                        _nss,
+                                        _collectionUuid,
+                                        _donorShardId,
+                                        _range,
                                         waitForDelete ? CleanWhenEnum::kNow
                                                       : CleanWhenEnum::kDelayed);
     donorDeletionTask.setPending(true);
 
-    LOG(0) << "Persisting range deletion task on donor for migration " << _migrationInfo.getId();
-    migrationutil::persistRangeDeletionTaskLocally(opCtx, donorDeletionTask);
+    LOG(0) << "Persisting migration coordinator doc and range deletion task on donor for migration "
+           << _migrationId;
+    migrationutil::persistMigrationStartLocally(
+        opCtx, _makeMigrationCoordinatorDocument(), donorDeletionTask);
 }
 
 void MigrationCoordinator::commitMigrationOnDonorAndRecipient(OperationContext* opCtx) {
-    LOG(0) << "Committing migration on donor and recipient for migration "
-           << _migrationInfo.getId();
-    LOG(0) << "Deleting range deletion task on recipient for migration " << _migrationInfo.getId();
+    LOG(0) << "Committing migration on donor and recipient for migration " << _migrationId;
+    LOG(0) << "Deleting range deletion task on recipient for migration " << _migrationId;
 
-    migrationutil::deleteRangeDeletionTaskOnRecipient(
-        opCtx, _migrationInfo.getRecipientShardId(), _migrationInfo.getId());
+    // The recipient and donor operations touch disjoint state, so kick off the recipient-side
+    // delete first and let its network round trip overlap the local write.
+    auto recipientFuture = migrationutil::deleteRangeDeletionTaskOnRecipientAsync(
+        opCtx->getServiceContext(), _getRecipientShard(opCtx), _migrationId);
 
     LOG(0) << "Marking range deletion task on donor as ready for processing for migration "
-           << _migrationInfo.getId();
-    migrationutil::markAsReadyRangeDeletionTaskLocally(opCtx, _migrationInfo.getId());
+           << _migrationId;
+    auto localStatus = [&] {
+        try {
+            migrationutil::markAsReadyRangeDeletionTaskLocally(opCtx, _migrationId);
+            return Status::OK();
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+    }();
+
+    // Always drain the recipient operation before surfacing either failure.
+    uassertStatusOK(std::move(recipientFuture).getNoThrow(opCtx));
+    uassertStatusOK(localStatus);
 }
 
 void MigrationCoordinator::abortMigrationOnDonorAndRecipient(OperationContext* opCtx) {
-    LOG(0) << "Aborting migration on donor and recipient for migration " << _migrationInfo.getId();
-    LOG(0) << "Deleting range deletion task on donor for migration " << _migrationInfo.getId();
-
-    migrationutil::deleteRangeDeletionTaskLocally(opCtx, _migrationInfo.getId());
-
+    LOG(0) << "Aborting migration on donor and recipient for migration " << _migrationId;
     LOG(0) << "Marking range deletion task on recipient as ready for processing for migration "
-           << _migrationInfo.getId();
+           << _migrationId;
+
+    // As in the commit path, overlap the recipient-side update with the local delete.
+    auto recipientFuture = migrationutil::markAsReadyRangeDeletionTaskOnRecipientAsync(
+        opCtx->getServiceContext(), _getRecipientShard(opCtx), _migrationId);
+
+    LOG(0) << "Deleting range deletion task on donor for migration " << _migrationId;
+    auto localStatus = [&] {
+        try {
+            migrationutil::deleteRangeDeletionTaskLocally(opCtx, _migrationId);
+            return Status::OK();
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+    }();
+
+    uassertStatusOK(std::move(recipientFuture).getNoThrow(opCtx));
+    uassertStatusOK(localStatus);
+}
+
+const std::shared_ptr<Shard>& MigrationCoordinator::_getRecipientShard(OperationContext* opCtx) {
+    if (!_recipientShard) {
+        _recipientShard = uassertStatusOK(
+            Grid::get(opCtx)->shardRegistry()->getShard(opCtx, _recipientShardId));
+    }
+    return _recipientShard;
+}
 
-    migrationutil::markAsReadyRangeDeletionTaskOnRecipient(
-        opCtx, _migrationInfo.getRecipientShardId(), _migrationInfo.getId());
+MigrationCoordinatorDocument MigrationCoordinator::_makeMigrationCoordinatorDocument() const {
+    return MigrationCoordinatorDocument(
+        _migrationId, _nss, _collectionUuid, _donorShardId, _recipientShardId, _range);
 }
 
 }  // namespace migrationutil
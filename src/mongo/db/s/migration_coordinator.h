@@ -29,11 +29,15 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/s/migration_coordinator_document_gen.h"
 #include "mongo/s/catalog/type_chunk.h"
 
 namespace mongo {
 
+class Shard;
+
 namespace migrationutil {
 /**
  * Manages the migration commit/abort process, including updates to config.rangeDeletions on the
@@ -62,9 +66,11 @@ public:
      * even after failover, by doing the following:
      *
      * 1) Inserts a document into the local config.migrationCoordinators with the lsid, txnNumber,
-     * and recipientId and waits for majority writeConcern.
+     * and recipientId.
      * 2) Inserts a document into the local config.rangeDeletions with the collectionUUID, range to
-     * delete, and "pending: true" and waits for majority writeConcern.
+     * delete, and "pending: true".
+     *
+     * Waits for majority writeConcern once, covering both inserts.
      */
     void startMigration(OperationContext* opCtx, bool waitForDelete);
 
@@ -81,7 +87,27 @@ public:
     void abortMigrationOnDonorAndRecipient(OperationContext* opCtx);
 
 private:
-    MigrationCoordinatorDocument _migrationInfo;
+    /**
+     * Returns the recipient Shard, resolving it through the shard registry on first use and
+     * caching the handle for the lifetime of the coordinator.
+     */
+    const std::shared_ptr<Shard>& _getRecipientShard(OperationContext* opCtx);
+
+    /**
+     * Materializes the document persisted to config.migrationCoordinators by startMigration().
+     * The commit/abort paths read the plain members below instead of going through the
+     * IDL-generated accessors, so the BSON-backed document is only built when persisting.
+     */
+    MigrationCoordinatorDocument _makeMigrationCoordinatorDocument() const;
+
+    UUID _migrationId;
+    NamespaceString _nss;
+    UUID _collectionUuid;
+    ShardId _donorShardId;
+    ShardId _recipientShardId;
+    ChunkRange _range;
+
+    std::shared_ptr<Shard> _recipientShard;
 };
 
 }  // namespace migrationutil
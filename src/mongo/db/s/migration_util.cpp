@@ -33,6 +33,8 @@
 
 #include "mongo/db/s/migration_util.h"
 
+#include <map>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/client/query.h"
@@ -67,61 +69,101 @@ const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 WriteConcernOptions::SyncMode::UNSET,
                                                 WriteConcernOptions::kNoTimeout);
 
+// Passthrough fields attached to every command sent to the recipient, cached so the write concern
+// isn't re-serialized per command.
+const BSONObj kMajorityWriteConcernPassthroughFields =
+    BSON(WriteConcernOptions::kWriteConcernField << kMajorityWriteConcern.toBSON());
+
+// Constant update document that clears a range deletion task's 'pending' flag, cached since it is
+// rebuilt identically for every migration commit.
+const BSONObj kUnsetPendingUpdate =
+    BSON("$unset" << BSON(RangeDeletionTask::kPendingFieldName << ""));
+
+// The task stores carry no per-operation state, so the helpers below share one instance per
+// namespace instead of constructing their own on every call.
+PersistentTaskStore<RangeDeletionTask>& rangeDeletionsStore() {
+    static auto& store =
+        *new PersistentTaskStore<RangeDeletionTask>(NamespaceString::kRangeDeletionNamespace);
+    return store;
+}
+
+PersistentTaskStore<MigrationCoordinatorDocument>& migrationCoordinatorsStore() {
+    static auto& store = *new PersistentTaskStore<MigrationCoordinatorDocument>(
+        NamespaceString::kMigrationCoordinatorsNamespace);
+    return store;
+}
+
+/**
+ * Builds a single-field {<field>: <uuid>} query with the builder pre-sized to the exact document
+ * length, avoiding the QUERY macro's default-sized buffer and its growth reallocations on the
+ * migration write paths.
+ */
+Query queryByUuid(StringData field, const UUID& uuid) {
+    // 4 (object length) + 1 (BinData type byte) + field length + 1 (field NUL) +
+    // 4 (BinData length) + 1 (BinData subtype) + 16 (UUID bytes) + 1 (EOO).
+    BSONObjBuilder builder(4 + 1 + static_cast<int>(field.size()) + 1 + 4 + 1 + 16 + 1);
+    uuid.appendToBuilder(&builder, field);
+    return Query(builder.obj());
+}
+
+// Dotted field paths of a RangeDeletionTask document's range bounds, precomputed because
+// overlappingRangeQuery() is called from migration commit paths.
+const std::string kRangeMinPath =
+    RangeDeletionTask::kRangeFieldName + "." + ChunkRange::kMinKey;
+const std::string kRangeMaxPath =
+    RangeDeletionTask::kRangeFieldName + "." + ChunkRange::kMaxKey;
+
 template <typename Cmd>
-void sendToRecipient(OperationContext* opCtx, const ShardId& recipientId, const Cmd& cmd) {
-    auto recipientShard =
-        uassertStatusOK(Grid::get(opCtx)->shardRegistry()->getShard(opCtx, recipientId));
+void sendToRecipient(OperationContext* opCtx,
+                     const std::shared_ptr<Shard>& recipientShard,
+                     const Cmd& cmd) {
+    auto cmdBSON = cmd.toBSON(kMajorityWriteConcernPassthroughFields);
 
-    LOG(1) << "Sending request " << cmd.toBSON({}) << " to recipient.";
+    LOG(1) << "Sending request " << cmdBSON << " to recipient.";
 
     auto response = recipientShard->runCommandWithFixedRetryAttempts(
         opCtx,
         ReadPreferenceSetting{ReadPreference::PrimaryOnly},
         "config",
-        cmd.toBSON({}),
+        cmdBSON,
         Shard::RetryPolicy::kIdempotent);
     uassertStatusOK(Shard::CommandResponse::getEffectiveStatus(response));
 }
 
-}  // namespace
-
-BSONObj makeMigrationStatusDocument(const NamespaceString& nss,
-                                    const ShardId& fromShard,
-                                    const ShardId& toShard,
-                                    const bool& isDonorShard,
-                                    const BSONObj& min,
-                                    const BSONObj& max) {
-    BSONObjBuilder builder;
-    builder.append(kSourceShard, fromShard.toString());
-    builder.append(kDestinationShard, toShard.toString());
-    builder.append(kIsDonorShard, isDonorShard);
-    builder.append(kChunk, BSON(ChunkType::min(min) << ChunkType::max(max)));
-    builder.append(kCollection, nss.ns());
-    return builder.obj();
-}
+/**
+ * Schedules 'task' (a callable taking an OperationContext*) on the fixed executor pool, running it
+ * under its own killable ThreadClient.
+ */
+template <typename Callable>
+SemiFuture<void> runOnFixedExecutor(ServiceContext* serviceContext, Callable task) {
+    auto executor = Grid::get(serviceContext)->getExecutorPool()->getFixedExecutor();
 
-Query overlappingRangeQuery(const ChunkRange& range, const UUID& uuid) {
-    return QUERY(RangeDeletionTask::kCollectionUuidFieldName
-                 << uuid << RangeDeletionTask::kRangeFieldName + "." + ChunkRange::kMinKey << LT
-                 << range.getMax() << RangeDeletionTask::kRangeFieldName + "." + ChunkRange::kMaxKey
-                 << GT << range.getMin());
-}
+    return ExecutorFuture<void>(executor)
+        .then([serviceContext, task = std::move(task)] {
+            ThreadClient tc("MigrationUtilAsyncTask", serviceContext);
+            {
+                stdx::lock_guard<Client> lk(*tc.get());
+                tc->setSystemOperationKillable(lk);
+            }
 
-bool checkForConflictingDeletions(OperationContext* opCtx,
-                                  const ChunkRange& range,
-                                  const UUID& uuid) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
+            auto opCtx = tc->makeOperationContext();
 
-    return store.count(opCtx, overlappingRangeQuery(range, uuid)) > 0;
+            task(opCtx.get());
+        })
+        .semi();
 }
 
-bool submitRangeDeletionTask(OperationContext* opCtx, const RangeDeletionTask& deletionTask) {
+/**
+ * Submits a RangeDeletionTask to the CollectionRangeDeleter for the collection already held by
+ * 'autoColl'. Returns false if the submission failed and is not retryable.
+ */
+bool submitRangeDeletionTaskWithCollection(OperationContext* opCtx,
+                                           const AutoGetCollection& autoColl,
+                                           const RangeDeletionTask& deletionTask) {
     const auto whenToClean = deletionTask.getWhenToClean() == CleanWhenEnum::kNow
         ? CollectionShardingRuntime::kNow
         : CollectionShardingRuntime::kDelayed;
 
-    AutoGetCollection autoColl(opCtx, deletionTask.getNss(), MODE_IS);
-
     if (!autoColl.getCollection()) {
         LOG(0) << "Namespace not found: " << deletionTask.getNss();
         return false;
@@ -158,25 +200,163 @@ bool submitRangeDeletionTask(OperationContext* opCtx, const RangeDeletionTask& d
     return true;
 }
 
-void submitPendingDeletions(OperationContext* opCtx) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
+/**
+ * Refreshes the filtering metadata for 'nss' and submits its pending deletion tasks to the range
+ * deleter. Returns the ids of the tasks that turned out to be invalid and should be removed from
+ * the store.
+ */
+std::vector<UUID> submitPendingDeletionsForNamespace(OperationContext* opCtx,
+                                                     const NamespaceString& nss,
+                                                     const std::vector<RangeDeletionTask>& tasks) {
+    // Skip the config server round trip when the filtering metadata is already known.  The check
+    // needs the collection lock, which cannot be held across the refresh, so it is taken in its
+    // own scope.
+    const bool metadataKnown = [&] {
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+        return static_cast<bool>(
+            CollectionShardingRuntime::get(opCtx, nss)->getCurrentMetadataIfKnown());
+    }();
+
+    if (!metadataKnown) {
+        forceShardFilteringMetadataRefresh(opCtx, nss, true);
+    }
 
-    auto query = QUERY("pending" << BSON("$exists" << false));
+    std::vector<UUID> invalidIds;
 
-    std::vector<RangeDeletionTask> invalidRanges;
-    store.forEach(opCtx, query, [&opCtx, &invalidRanges](const RangeDeletionTask& deletionTask) {
-        forceShardFilteringMetadataRefresh(opCtx, deletionTask.getNss(), true);
+    AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+    for (const auto& deletionTask : tasks) {
+        if (!submitRangeDeletionTaskWithCollection(opCtx, autoColl, deletionTask))
+            invalidIds.push_back(deletionTask.getId());
+    }
 
-        auto taskValid = migrationutil::submitRangeDeletionTask(opCtx, deletionTask);
+    return invalidIds;
+}
 
-        if (!taskValid)
-            invalidRanges.push_back(deletionTask);
+}  // namespace
 
+BSONObj makeMigrationStatusDocument(const NamespaceString& nss,
+                                    const ShardId& fromShard,
+                                    const ShardId& toShard,
+                                    const bool& isDonorShard,
+                                    const BSONObj& min,
+                                    const BSONObj& max) {
+    const auto source = fromShard.toString();
+    const auto destination = toShard.toString();
+    const auto collection = nss.ns();
+
+    // This runs on every currentOp reporter tick, so reserve the output size up front (the fixed
+    // field names plus the varying values) and build the chunk bounds directly into the outer
+    // buffer, instead of assembling them in a temporary object and copying it in.
+    BSONObjBuilder builder(static_cast<int>(128 + source.size() + destination.size() +
+                                            collection.size() + min.objsize() + max.objsize()));
+    builder.append(kSourceShard, source);
+    builder.append(kDestinationShard, destination);
+    builder.append(kIsDonorShard, isDonorShard);
+    {
+        BSONObjBuilder chunkBuilder(builder.subobjStart(kChunk));
+        chunkBuilder.append(ChunkType::min.name(), min);
+        chunkBuilder.append(ChunkType::max.name(), max);
+    }
+    builder.append(kCollection, collection);
+    return builder.obj();
+}
+
+Query overlappingRangeQuery(const ChunkRange& range, const UUID& uuid) {
+    return QUERY(RangeDeletionTask::kCollectionUuidFieldName
+                 << uuid << kRangeMinPath << LT << range.getMax() << kRangeMaxPath << GT
+                 << range.getMin());
+}
+
+bool checkForConflictingDeletions(OperationContext* opCtx,
+                                  const ChunkRange& range,
+                                  const UUID& uuid) {
+    return rangeDeletionsStore().count(opCtx, overlappingRangeQuery(range, uuid)) > 0;
+}
+
+bool submitRangeDeletionTask(OperationContext* opCtx, const RangeDeletionTask& deletionTask) {
+    AutoGetCollection autoColl(opCtx, deletionTask.getNss(), MODE_IS);
+    return submitRangeDeletionTaskWithCollection(opCtx, autoColl, deletionTask);
+}
+
+void submitPendingDeletions(OperationContext* opCtx) {
+    auto& store = rangeDeletionsStore();
+
+    auto query = QUERY("pending" << BSON("$exists" << false));
+
+    // Group the pending tasks by namespace, so the filtering metadata refresh and the collection
+    // lock are taken once per collection rather than once per task.
+    std::map<NamespaceString, std::vector<RangeDeletionTask>> tasksByNss;
+    store.forEach(opCtx, query, [&tasksByNss](const RangeDeletionTask& deletionTask) {
+        tasksByNss[deletionTask.getNss()].push_back(deletionTask);
         return true;
     });
 
-    for (const auto& range : invalidRanges) {
-        store.remove(opCtx, Query(range.toBSON()));
+    if (tasksByNss.empty())
+        return;
+
+    std::vector<UUID> invalidIds;
+
+    if (tasksByNss.size() == 1) {
+        // Don't pay for an executor round trip when there is only one collection to process.
+        const auto& entry = *tasksByNss.begin();
+        invalidIds = submitPendingDeletionsForNamespace(opCtx, entry.first, entry.second);
+    } else {
+        // Fan the per-collection work out onto the fixed executor pool so that the config server
+        // round trips done by the metadata refreshes overlap, instead of paying one network round
+        // trip per collection serially.  The fixed executor's thread pool has no maxThreads limit,
+        // so dispatch in fixed-size batches to bound how many collection locks and config server
+        // refreshes are in flight at once (this runs on step-up, when every collection with
+        // pending deletions is submitted here together).
+        constexpr size_t kMaxConcurrentNamespaceSubmissions = 8;
+
+        auto executor = Grid::get(opCtx)->getExecutorPool()->getFixedExecutor();
+        auto serviceContext = opCtx->getServiceContext();
+
+        auto status = Status::OK();
+        for (auto it = tasksByNss.begin(); it != tasksByNss.end();) {
+            std::vector<ExecutorFuture<std::vector<UUID>>> futures;
+            for (; it != tasksByNss.end() && futures.size() < kMaxConcurrentNamespaceSubmissions;
+                 ++it) {
+                futures.push_back(ExecutorFuture<void>(executor).then(
+                    [serviceContext, nss = it->first, tasks = it->second] {
+                        ThreadClient tc("SubmitPendingDeletions", serviceContext);
+                        {
+                            stdx::lock_guard<Client> lk(*tc.get());
+                            tc->setSystemOperationKillable(lk);
+                        }
+
+                        auto taskOpCtx = tc->makeOperationContext();
+
+                        return submitPendingDeletionsForNamespace(taskOpCtx.get(), nss, tasks);
+                    }));
+            }
+
+            // Wait for the whole batch before scheduling the next one, both to enforce the
+            // concurrency bound and so that, on failure, no group is left running against a store
+            // we are about to clean up.
+            for (auto& future : futures) {
+                auto swInvalidIds = std::move(future).getNoThrow(opCtx);
+                if (!swInvalidIds.isOK()) {
+                    if (status.isOK())
+                        status = swInvalidIds.getStatus();
+                    continue;
+                }
+
+                auto& ids = swInvalidIds.getValue();
+                invalidIds.insert(invalidIds.end(), ids.begin(), ids.end());
+            }
+        }
+        uassertStatusOK(status);
+    }
+
+    if (!invalidIds.empty()) {
+        // Remove all invalid tasks with a single batched delete rather than one write (each with
+        // its own majority wait) per task.
+        BSONArrayBuilder ids;
+        for (const auto& id : invalidIds) {
+            id.appendToArrayBuilder(&ids);
+        }
+        store.remove(opCtx, QUERY(RangeDeletionTask::kIdFieldName << BSON("$in" << ids.arr())));
     }
 }
 
@@ -205,11 +385,10 @@ void dropRangeDeletionsCollection(OperationContext* opCtx) {
 }
 
 void persistMigrationCoordinatorLocally(OperationContext* opCtx,
-                                        const MigrationCoordinatorDocument& migrationDoc) {
-    PersistentTaskStore<MigrationCoordinatorDocument> store(
-        opCtx, NamespaceString::kMigrationCoordinatorsNamespace);
+                                        const MigrationCoordinatorDocument& migrationDoc,
+                                        const WriteConcernOptions& writeConcern) {
     try {
-        store.add(opCtx, migrationDoc);
+        migrationCoordinatorsStore().add(opCtx, migrationDoc, writeConcern);
     } catch (const ExceptionFor<ErrorCodes::DuplicateKey>&) {
         // Convert a DuplicateKey error to an anonymous error.
         uasserted(
@@ -221,10 +400,10 @@ void persistMigrationCoordinatorLocally(OperationContext* opCtx,
 }
 
 void persistRangeDeletionTaskLocally(OperationContext* opCtx,
-                                     const RangeDeletionTask& deletionTask) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
+                                     const RangeDeletionTask& deletionTask,
+                                     const WriteConcernOptions& writeConcern) {
     try {
-        store.add(opCtx, deletionTask);
+        rangeDeletionsStore().add(opCtx, deletionTask, writeConcern);
     } catch (const ExceptionFor<ErrorCodes::DuplicateKey>&) {
         // Convert a DuplicateKey error to an anonymous error.
         uasserted(31375,
@@ -235,49 +414,79 @@ void persistRangeDeletionTaskLocally(OperationContext* opCtx,
     }
 }
 
+void persistMigrationStartLocally(OperationContext* opCtx,
+                                  const MigrationCoordinatorDocument& migrationDoc,
+                                  const RangeDeletionTask& deletionTask) {
+    // Perform both inserts with local write concern and wait for majority once afterwards, so a
+    // migration start pays a single majority replication round trip instead of two.
+    persistMigrationCoordinatorLocally(opCtx, migrationDoc, WriteConcernOptions());
+    persistRangeDeletionTaskLocally(opCtx, deletionTask, WriteConcernOptions());
+
+    auto latestOpTime = repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp();
+    WriteConcernResult ignoreResult;
+    uassertStatusOK(waitForWriteConcern(
+        opCtx, latestOpTime, WriteConcerns::kMajorityWriteConcern, &ignoreResult));
+}
+
 void deleteRangeDeletionTaskOnRecipient(OperationContext* opCtx,
-                                        const ShardId& recipientId,
+                                        const std::shared_ptr<Shard>& recipientShard,
                                         const UUID& migrationId) {
     write_ops::Delete deleteOp(NamespaceString::kRangeDeletionNamespace);
     write_ops::DeleteOpEntry query(BSON(RangeDeletionTask::kIdFieldName << migrationId),
                                    false /*multi*/);
     deleteOp.setDeletes({query});
 
-    sendToRecipient(opCtx, recipientId, deleteOp);
+    sendToRecipient(opCtx, recipientShard, deleteOp);
+}
+
+SemiFuture<void> deleteRangeDeletionTaskOnRecipientAsync(ServiceContext* serviceContext,
+                                                         std::shared_ptr<Shard> recipientShard,
+                                                         const UUID& migrationId) {
+    return runOnFixedExecutor(
+        serviceContext,
+        [recipientShard = std::move(recipientShard), migrationId](OperationContext* opCtx) {
+            deleteRangeDeletionTaskOnRecipient(opCtx, recipientShard, migrationId);
+        });
 }
 
 void deleteRangeDeletionTaskLocally(OperationContext* opCtx, const UUID& deletionTaskId) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
-    store.remove(opCtx, QUERY(RangeDeletionTask::kIdFieldName << deletionTaskId));
+    rangeDeletionsStore().remove(opCtx,
+                                 queryByUuid(RangeDeletionTask::kIdFieldName, deletionTaskId));
 }
 
 void deleteRangeDeletionTasksForCollectionLocally(OperationContext* opCtx,
                                                   const UUID& collectionUuid) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
-    store.remove(opCtx, QUERY(RangeDeletionTask::kCollectionUuidFieldName << collectionUuid));
+    rangeDeletionsStore().remove(
+        opCtx, queryByUuid(RangeDeletionTask::kCollectionUuidFieldName, collectionUuid));
 }
 
 void markAsReadyRangeDeletionTaskOnRecipient(OperationContext* opCtx,
-                                             const ShardId& recipientId,
+                                             const std::shared_ptr<Shard>& recipientShard,
                                              const UUID& migrationId) {
     write_ops::Update updateOp(NamespaceString::kRangeDeletionNamespace);
     auto queryFilter = BSON(RangeDeletionTask::kIdFieldName << migrationId);
-    auto updateModification = write_ops::UpdateModification(
-        BSON("$unset" << BSON(RangeDeletionTask::kPendingFieldName << "")));
+    auto updateModification = write_ops::UpdateModification(kUnsetPendingUpdate);
     write_ops::UpdateOpEntry updateEntry(queryFilter, updateModification);
     updateEntry.setMulti(false);
     updateEntry.setUpsert(false);
     updateOp.setUpdates({updateEntry});
 
-    sendToRecipient(opCtx, recipientId, updateOp);
+    sendToRecipient(opCtx, recipientShard, updateOp);
 }
 
-void markAsReadyRangeDeletionTaskLocally(OperationContext* opCtx, const UUID& migrationId) {
-    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
-    auto query = QUERY(RangeDeletionTask::kIdFieldName << migrationId);
-    auto update = BSON("$unset" << BSON(RangeDeletionTask::kPendingFieldName << ""));
+SemiFuture<void> markAsReadyRangeDeletionTaskOnRecipientAsync(ServiceContext* serviceContext,
+                                                              std::shared_ptr<Shard> recipientShard,
+                                                              const UUID& migrationId) {
+    return runOnFixedExecutor(
+        serviceContext,
+        [recipientShard = std::move(recipientShard), migrationId](OperationContext* opCtx) {
+            markAsReadyRangeDeletionTaskOnRecipient(opCtx, recipientShard, migrationId);
+        });
+}
 
-    store.update(opCtx, query, update);
+void markAsReadyRangeDeletionTaskLocally(OperationContext* opCtx, const UUID& migrationId) {
+    rangeDeletionsStore().update(
+        opCtx, queryByUuid(RangeDeletionTask::kIdFieldName, migrationId), kUnsetPendingUpdate);
 }
 }  // namespace migrationutil
 }  // namespace mongo
@@ -29,17 +29,21 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/s/migration_coordinator_document_gen.h"
 #include "mongo/db/s/persistent_task_store.h"
 #include "mongo/db/s/range_deletion_task_gen.h"
 #include "mongo/s/catalog/type_chunk.h"
+#include "mongo/util/future.h"
 
 namespace mongo {
 
 class BSONObj;
 class NamespaceString;
+class Shard;
 class ShardId;
 
 namespace migrationutil {
@@ -87,18 +91,31 @@ void resubmitRangeDeletionsOnStepUp(ServiceContext* serviceContext);
 void dropRangeDeletionsCollection(OperationContext* opCtx);
 
 /**
- * Writes the migration coordinator document to config.migrationCoordinators and waits for majority
- * write concern.
+ * Writes the migration coordinator document to config.migrationCoordinators and waits for the
+ * given write concern.
  */
-void persistMigrationCoordinatorLocally(OperationContext* opCtx,
-                                        const MigrationCoordinatorDocument& migrationDoc);
+void persistMigrationCoordinatorLocally(
+    OperationContext* opCtx,
+    const MigrationCoordinatorDocument& migrationDoc,
+    const WriteConcernOptions& writeConcern = WriteConcerns::kMajorityWriteConcern);
 
 /**
- * Writes the range deletion task document to config.rangeDeletions and waits for majority write
+ * Writes the range deletion task document to config.rangeDeletions and waits for the given write
  * concern.
  */
-void persistRangeDeletionTaskLocally(OperationContext* opCtx,
-                                     const RangeDeletionTask& deletionTask);
+void persistRangeDeletionTaskLocally(
+    OperationContext* opCtx,
+    const RangeDeletionTask& deletionTask,
+    const WriteConcernOptions& writeConcern = WriteConcerns::kMajorityWriteConcern);
+
+/**
+ * Writes the migration coordinator document to config.migrationCoordinators and the range deletion
+ * task document to config.rangeDeletions, then waits once for both writes to become majority
+ * committed, rather than paying one majority replication round trip per insert.
+ */
+void persistMigrationStartLocally(OperationContext* opCtx,
+                                  const MigrationCoordinatorDocument& migrationDoc,
+                                  const RangeDeletionTask& deletionTask);
 
 /**
  * Deletes the range deletion task document with the specified id from config.rangeDeletions and
@@ -118,9 +135,17 @@ void deleteRangeDeletionTasksForCollectionLocally(OperationContext* opCtx,
  * specified shard and waits for majority write concern.
  */
 void deleteRangeDeletionTaskOnRecipient(OperationContext* opCtx,
-                                        const ShardId& recipientId,
+                                        const std::shared_ptr<Shard>& recipientShard,
                                         const UUID& migrationId);
 
+/**
+ * Same as deleteRangeDeletionTaskOnRecipient, but runs on the fixed executor pool so the network
+ * round trip to the recipient can overlap work on the calling thread.
+ */
+SemiFuture<void> deleteRangeDeletionTaskOnRecipientAsync(ServiceContext* serviceContext,
+                                                         std::shared_ptr<Shard> recipientShard,
+                                                         const UUID& migrationId);
+
 /**
  * Removes the 'pending' flag from the range deletion task document with the specified id from
  * config.rangeDeletions and waits for majority write concern. This marks the range as ready for
@@ -135,7 +160,15 @@ void markAsReadyRangeDeletionTaskLocally(OperationContext* opCtx, const UUID& mi
  * range as ready for deletion.
  */
 void markAsReadyRangeDeletionTaskOnRecipient(OperationContext* opCtx,
-                                             const ShardId& recipientId,
+                                             const std::shared_ptr<Shard>& recipientShard,
                                              const UUID& migrationId);
+
+/**
+ * Same as markAsReadyRangeDeletionTaskOnRecipient, but runs on the fixed executor pool so the
+ * network round trip to the recipient can overlap work on the calling thread.
+ */
+SemiFuture<void> markAsReadyRangeDeletionTaskOnRecipientAsync(ServiceContext* serviceContext,
+                                                              std::shared_ptr<Shard> recipientShard,
+                                                              const UUID& migrationId);
 }  // namespace migrationutil
 }  // namespace mongo
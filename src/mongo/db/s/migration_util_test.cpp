@@ -437,5 +437,33 @@ TEST_F(MigrationUtilsTest, TestInvalidRangeIsDeleted) {
     ASSERT_EQ(store.count(opCtx), 0);
 }
 
+TEST_F(MigrationUtilsTest, TestInvalidRangesAcrossMultipleCollectionsAreDeleted) {
+    auto opCtx = operationContext();
+    const NamespaceString otherNss{"test.bar"};
+
+    // Mark the filtering metadata for both collections as known (unsharded), so the submission
+    // tasks fanned out on the executor do not attempt to refresh it from the config server.
+    for (const auto& nss : {kNss, otherNss}) {
+        AutoGetCollection autoColl(opCtx, nss, MODE_X);
+        CollectionShardingRuntime::get(opCtx, nss)->setFilteringMetadata(opCtx,
+                                                                         CollectionMetadata());
+    }
+
+    PersistentTaskStore<RangeDeletionTask> store(opCtx, NamespaceString::kRangeDeletionNamespace);
+
+    // Neither collection exists, so all tasks are invalid.  Using more than one namespace makes
+    // submitPendingDeletions take the parallel executor path rather than the inline one, and the
+    // invalid tasks from both collections must all be removed by its single batched delete.
+    store.add(opCtx, createDeletionTask(kNss, UUID::gen(), 0, 10));
+    store.add(opCtx, createDeletionTask(kNss, UUID::gen(), 10, 20));
+    store.add(opCtx, createDeletionTask(otherNss, UUID::gen(), 0, 10));
+
+    ASSERT_EQ(store.count(opCtx), 3);
+
+    migrationutil::submitPendingDeletions(opCtx);
+
+    ASSERT_EQ(store.count(opCtx), 0);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -50,8 +50,14 @@ const WriteConcernOptions kMajorityWriteConcern{WriteConcernOptions::kMajority,
 template <typename T>
 class PersistentTaskStore {
 public:
+    /**
+     * A PersistentTaskStore carries no state other than the namespace it writes to, so a single
+     * instance may be freely reused across operations and threads.
+     */
+    explicit PersistentTaskStore(NamespaceString storageNss) : _storageNss(std::move(storageNss)) {}
+
     PersistentTaskStore(OperationContext* opCtx, NamespaceString storageNss)
-        : _storageNss(std::move(storageNss)) {}
+        : PersistentTaskStore(std::move(storageNss)) {}
 
     /**
      * Adds a task to the store.